@@ -2,28 +2,66 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <limits.h>
 
 #define MIN_DEGREE 2
 #define MAX_KEYS (2 * MIN_DEGREE - 1)    
 #define MIN_KEYS (MIN_DEGREE - 1)        
 #define MAX_CHILDREN (2 * MIN_DEGREE)    
 
+/* Limiares da representação adaptativa de diretórios (ajustáveis com -D na compilação).
+   Diretórios pequenos usam um vetor ordenado inline; acima de DIR_INLINE_MAX entradas
+   passam a usar Árvore B e voltam ao vetor quando caem para DIR_INLINE_DEMOTE.
+   A partir de DIR_HASH_PROMOTE entradas um índice hash é mantido ao lado da Árvore B
+   e é descartado quando o diretório cai para DIR_HASH_DEMOTE. */
+#ifndef DIR_INLINE_MAX
+#define DIR_INLINE_MAX 8
+#endif
+#ifndef DIR_INLINE_DEMOTE
+#define DIR_INLINE_DEMOTE 4
+#endif
+#ifndef DIR_HASH_PROMOTE
+#define DIR_HASH_PROMOTE 4096
+#endif
+#ifndef DIR_HASH_DEMOTE
+#define DIR_HASH_DEMOTE 2048
+#endif
+
+/* Numa transação, o diretório é reconstruído em uma única passada quando o número de
+   operações vezes BATCH_REBUILD_RATIO alcança o número de entradas; abaixo disso as
+   operações são aplicadas uma a uma (ajustável com -D na compilação). */
+#ifndef BATCH_REBUILD_RATIO
+#define BATCH_REBUILD_RATIO 8
+#endif
+
+#if DIR_INLINE_DEMOTE < 0 || DIR_INLINE_DEMOTE >= DIR_INLINE_MAX
+#error "DIR_INLINE_DEMOTE deve estar entre 0 e DIR_INLINE_MAX - 1"
+#endif
+#if DIR_HASH_DEMOTE <= DIR_INLINE_MAX || DIR_HASH_DEMOTE >= DIR_HASH_PROMOTE
+#error "é necessário DIR_INLINE_MAX < DIR_HASH_DEMOTE < DIR_HASH_PROMOTE"
+#endif
+
 /* Tipos de nó: Arquivo ou Diretório */
 typedef enum { FILE_TYPE, DIRECTORY_TYPE } NodeType;
 
+/* Declaração antecipada das estruturas Directory e BTree */
+struct Directory;
+typedef struct Directory Directory;
+struct BTree;
+typedef struct BTree BTree;
+
 /* Estrutura para representar um arquivo */
 typedef struct File {
     char* name;
     char* content;
     size_t size;
+    time_t criado;        /* instante de criação */
+    time_t modificado;    /* instante da última modificação */
+    Directory* parent;    /* diretório que contém o arquivo */
 } File;
 
-/* Declaração antecipada das estruturas Directory e BTree */
-struct Directory;
-typedef struct Directory Directory;
-struct BTree;
-typedef struct BTree BTree;
-
 /* Estrutura para representar um nó genérico (arquivo ou diretório) na árvore de arquivos */
 typedef struct TreeNode {
     char* name;
@@ -34,9 +72,23 @@ typedef struct TreeNode {
     } data;
 } TreeNode;
 
+/* Índice hash de nomes (endereçamento aberto com sondagem linear) para diretórios grandes */
+typedef struct DirHash {
+    TreeNode** slots;
+    size_t capacidade;   /* sempre potência de 2 */
+    size_t n;
+} DirHash;
+
+/* Representação atual das entradas de um diretório */
+typedef enum { DIR_INLINE, DIR_BTREE } DirMode;
+
 /* Estrutura para representar um diretório */
 struct Directory {
-    BTree* tree;         
+    DirMode modo;
+    int n;                                    /* total de entradas */
+    TreeNode* inline_chaves[DIR_INLINE_MAX];  /* vetor ordenado (modo DIR_INLINE) */
+    BTree* tree;                              /* NULL no modo DIR_INLINE */
+    DirHash* hash;                            /* NULL exceto em diretórios grandes */
     Directory* parent;   
     char* name;          
 };
@@ -49,12 +101,21 @@ typedef struct BTreeNode {
     struct BTreeNode* filhos[MAX_CHILDREN]; 
 } BTreeNode;
 
+/* Função de ordenação das chaves de uma Árvore B (negativo, zero ou positivo, como strcmp) */
+typedef int (*BTreeCmp)(const TreeNode* a, const TreeNode* b);
+
 /* Estrutura da Árvore B */
 struct BTree {
     BTreeNode* raiz;    
     int t;              
+    BTreeCmp cmp;       
 };
 
+/* Ordenação padrão das árvores de diretório: pelo nome da entrada */
+int btree_cmp_nome(const TreeNode* a, const TreeNode* b) {
+    return strcmp(a->name, b->name);
+}
+
 /* Cria um novo nó BTreeNode (folha ou interno) */
 BTreeNode* btree_node_create(bool folha) {
     BTreeNode* node = (BTreeNode*) malloc(sizeof(BTreeNode));
@@ -71,39 +132,53 @@ BTreeNode* btree_node_create(bool folha) {
     return node;
 }
 
-/* Inicializa uma nova árvore B vazia e retorna seu ponteiro */
-BTree* btree_create() {
+/* Inicializa uma nova árvore B vazia ordenada por cmp e retorna seu ponteiro */
+BTree* btree_create_ordered(BTreeCmp cmp) {
     BTree* tree = (BTree*) malloc(sizeof(BTree));
     if (!tree) {
         fprintf(stderr, "Erro de alocação de memória ao criar árvore B.\n");
         exit(EXIT_FAILURE);
     }
     tree->t = MIN_DEGREE;
+    tree->cmp = cmp;
 
     tree->raiz = btree_node_create(true);
     return tree;
 }
 
-/* Função recursiva para buscar uma chave (nome) na subárvore enraizada no nó x */
-TreeNode* btree_search_node(BTreeNode* x, const char* name) {
+/* Inicializa uma nova árvore B vazia ordenada por nome e retorna seu ponteiro */
+BTree* btree_create() {
+    return btree_create_ordered(btree_cmp_nome);
+}
+
+/* Função recursiva para buscar a chave equivalente a 'alvo' na subárvore enraizada no nó x */
+TreeNode* btree_search_node(BTreeNode* x, const TreeNode* alvo, BTreeCmp cmp) {
     int i = 0;
     
-    while (i < x->n && strcmp(name, x->chaves[i]->name) > 0) {
+    while (i < x->n && cmp(alvo, x->chaves[i]) > 0) {
         i++;
     }
-    if (i < x->n && strcmp(name, x->chaves[i]->name) == 0) {
+    if (i < x->n && cmp(alvo, x->chaves[i]) == 0) {
         return x->chaves[i];
     }
     if (x->folha) {
         return NULL;
     }
-    return btree_search_node(x->filhos[i], name);
+    return btree_search_node(x->filhos[i], alvo, cmp);
 }
 
-/* Busca uma chave na árvore B a partir da raiz */
-TreeNode* btree_search(BTree* tree, const char* name) {
+/* Busca a chave equivalente a 'alvo' (segundo a ordenação da árvore) a partir da raiz */
+TreeNode* btree_search_key(BTree* tree, const TreeNode* alvo) {
     if (!tree || !tree->raiz) return NULL;
-    return btree_search_node(tree->raiz, name);
+    return btree_search_node(tree->raiz, alvo, tree->cmp);
+}
+
+/* Busca uma chave (nome) na árvore B a partir da raiz (apenas árvores ordenadas por nome) */
+TreeNode* btree_search(BTree* tree, const char* name) {
+    if (!tree || tree->cmp != btree_cmp_nome) return NULL;
+    TreeNode chave;
+    chave.name = (char*) name;
+    return btree_search_key(tree, &chave);
 }
 
 /* Divide o filho y do nó x em dois, quando y está cheio. 
@@ -134,27 +209,27 @@ void btree_split_child(BTreeNode* x, int i, BTreeNode* y) {
 }
 
 /* Insere o TreeNode *novo em um nó (subárvore) que *não* está cheio */
-void btree_insert_nonfull(BTreeNode* x, TreeNode* novo) {
+void btree_insert_nonfull(BTreeNode* x, TreeNode* novo, BTreeCmp cmp) {
     int i = x->n - 1;
     if (x->folha) {
-        while (i >= 0 && strcmp(novo->name, x->chaves[i]->name) < 0) {
+        while (i >= 0 && cmp(novo, x->chaves[i]) < 0) {
             x->chaves[i + 1] = x->chaves[i];
             i--;
         }
         x->chaves[i + 1] = novo;
         x->n += 1;
     } else {
-        while (i >= 0 && strcmp(novo->name, x->chaves[i]->name) < 0) {
+        while (i >= 0 && cmp(novo, x->chaves[i]) < 0) {
             i--;
         }
         i++;
         if (x->filhos[i]->n == MAX_KEYS) {
             btree_split_child(x, i, x->filhos[i]);
-            if (strcmp(novo->name, x->chaves[i]->name) > 0) {
+            if (cmp(novo, x->chaves[i]) > 0) {
                 i++;
             }
         }
-        btree_insert_nonfull(x->filhos[i], novo);
+        btree_insert_nonfull(x->filhos[i], novo, cmp);
     }
 }
 
@@ -166,13 +241,13 @@ bool btree_insert(BTree* tree, TreeNode* novo) {
         s->filhos[0] = r;
         btree_split_child(s, 0, r);
         int i = 0;
-        if (strcmp(novo->name, s->chaves[0]->name) > 0) {
+        if (tree->cmp(novo, s->chaves[0]) > 0) {
             i = 1;
         }
-        btree_insert_nonfull(s->filhos[i], novo);
+        btree_insert_nonfull(s->filhos[i], novo, tree->cmp);
         tree->raiz = s; 
     } else {
-        btree_insert_nonfull(r, novo);
+        btree_insert_nonfull(r, novo, tree->cmp);
     }
     return true;
 }
@@ -275,13 +350,13 @@ void btree_merge_children(BTreeNode* x, int idx) {
     free(sibling);
 }
 
-/* Remove recursivamente a chave 'name' da subarvore enraizada em x (assume que a chave existe na árvore) */
-void btree_delete_from_node(BTreeNode* x, const char* name) {
+/* Remove recursivamente a chave equivalente a 'alvo' da subarvore enraizada em x (assume que a chave existe na árvore) */
+void btree_delete_from_node(BTreeNode* x, const TreeNode* alvo, BTreeCmp cmp) {
     int idx = 0;
-    while (idx < x->n && strcmp(name, x->chaves[idx]->name) > 0) {
+    while (idx < x->n && cmp(alvo, x->chaves[idx]) > 0) {
         idx++;
     }
-    if (idx < x->n && strcmp(name, x->chaves[idx]->name) == 0) {
+    if (idx < x->n && cmp(alvo, x->chaves[idx]) == 0) {
         if (x->folha) {
             for (int j = idx; j < x->n - 1; j++) {
                 x->chaves[j] = x->chaves[j + 1];
@@ -293,14 +368,14 @@ void btree_delete_from_node(BTreeNode* x, const char* name) {
             if (y->n >= MIN_DEGREE) {
                 TreeNode* pred = btree_get_predecessor(x, idx);
                 x->chaves[idx] = pred;  
-                btree_delete_from_node(y, pred->name); 
+                btree_delete_from_node(y, pred, cmp); 
             } else if (z->n >= MIN_DEGREE) {
                 TreeNode* succ = btree_get_successor(x, idx);
                 x->chaves[idx] = succ;
-                btree_delete_from_node(z, succ->name);
+                btree_delete_from_node(z, succ, cmp);
             } else {
                 btree_merge_children(x, idx);
-                btree_delete_from_node(y, name);
+                btree_delete_from_node(y, alvo, cmp);
             }
         }
     } else {
@@ -326,23 +401,17 @@ void btree_delete_from_node(BTreeNode* x, const char* name) {
             }
         }
         if (ultimoFilho && idx > x->n) {
-            btree_delete_from_node(x->filhos[idx - 1], name);
+            btree_delete_from_node(x->filhos[idx - 1], alvo, cmp);
         } else {
-            btree_delete_from_node(x->filhos[idx], name);
+            btree_delete_from_node(x->filhos[idx], alvo, cmp);
         }
     }
 }
 
-/* Remove uma chave da árvore B (se existir) e retorna o TreeNode removido ou NULL */
-TreeNode* btree_delete(BTree* tree, const char* name) {
-    if (!tree || !tree->raiz) return NULL;
+/* Remove da árvore B uma chave que se sabe presente, com uma única descida */
+void btree_remove_present(BTree* tree, const TreeNode* alvo) {
     BTreeNode* r = tree->raiz;
-    TreeNode* removido = btree_search(tree, name);
-    if (removido == NULL) {
-        return NULL;  
-    }
-
-    btree_delete_from_node(r, name);
+    btree_delete_from_node(r, alvo, tree->cmp);
     if (r->n == 0) {
         if (!r->folha) {
             tree->raiz = r->filhos[0];
@@ -351,34 +420,138 @@ TreeNode* btree_delete(BTree* tree, const char* name) {
             free(r);
         }
     }
+}
+
+/* Remove a chave equivalente a 'alvo' da árvore B (se existir) e retorna o TreeNode removido ou NULL */
+TreeNode* btree_delete_key(BTree* tree, const TreeNode* alvo) {
+    if (!tree || !tree->raiz) return NULL;
+    TreeNode* removido = btree_search_key(tree, alvo);
+    if (removido == NULL) {
+        return NULL;  
+    }
+
+    btree_remove_present(tree, alvo);
     return removido;
 }
 
-/* Percorre a árvore B e imprime os nomes das entradas em ordem (uso em listagem) */
-void btree_traverse_node(BTreeNode* x) {
+/* Remove uma chave (nome) da árvore B (se existir) e retorna o TreeNode removido ou NULL
+   (apenas árvores ordenadas por nome) */
+TreeNode* btree_delete(BTree* tree, const char* name) {
+    if (!tree || tree->cmp != btree_cmp_nome) return NULL;
+    TreeNode chave;
+    chave.name = (char*) name;
+    return btree_delete_key(tree, &chave);
+}
+
+/* Percorre a subárvore enraizada em x em ordem, chamando visita() para cada entrada */
+void btree_foreach_node(BTreeNode* x, void (*visita)(TreeNode*, void*), void* ctx) {
     int i;
     for (i = 0; i < x->n; i++) {
         if (!x->folha) {
-            btree_traverse_node(x->filhos[i]);
-        }
-        if (x->chaves[i]->type == DIRECTORY_TYPE) {
-            printf("%s/\n", x->chaves[i]->name);
-        } else {
-            printf("%s\n", x->chaves[i]->name);
+            btree_foreach_node(x->filhos[i], visita, ctx);
         }
+        visita(x->chaves[i], ctx);
     }
     if (!x->folha) {
-        btree_traverse_node(x->filhos[i]);
+        btree_foreach_node(x->filhos[i], visita, ctx);
     }
 }
 
-/* Interface pública para percorrer a árvore B de um diretório e listar seu conteúdo */
-void btree_traverse(BTree* tree) {
+/* Interface pública para percorrer a árvore B em ordem */
+void btree_foreach(BTree* tree, void (*visita)(TreeNode*, void*), void* ctx) {
     if (tree != NULL && tree->raiz != NULL) {
-        btree_traverse_node(tree->raiz);
+        btree_foreach_node(tree->raiz, visita, ctx);
     }
 }
 
+/* Visita, em ordem, as entradas da subárvore x cuja chave numérica está em [min, max].
+   A árvore deve estar ordenada primeiro por essa chave; subárvores fora do intervalo não
+   são visitadas, de modo que o custo é O(log n + k). */
+void btree_range_node(BTreeNode* x, long long min, long long max, long long (*chave)(const TreeNode*),
+                      void (*visita)(TreeNode*, void*), void* ctx) {
+    int i;
+    for (i = 0; i < x->n; i++) {
+        long long k = chave(x->chaves[i]);
+        if (k >= min && !x->folha) {
+            btree_range_node(x->filhos[i], min, max, chave, visita, ctx);
+        }
+        if (k > max) {
+            return;
+        }
+        if (k >= min) {
+            visita(x->chaves[i], ctx);
+        }
+    }
+    if (!x->folha) {
+        btree_range_node(x->filhos[i], min, max, chave, visita, ctx);
+    }
+}
+
+/* Interface pública para a consulta por intervalo na árvore B */
+void btree_range(BTree* tree, long long min, long long max, long long (*chave)(const TreeNode*),
+                 void (*visita)(TreeNode*, void*), void* ctx) {
+    if (tree != NULL && tree->raiz != NULL && min <= max) {
+        btree_range_node(tree->raiz, min, max, chave, visita, ctx);
+    }
+}
+
+/* Capacidade máxima de chaves de uma subárvore com 'altura' níveis */
+long long btree_capacidade(int altura) {
+    long long cap = 1;
+    for (int i = 0; i < altura; i++) {
+        cap *= MAX_CHILDREN;
+    }
+    return cap - 1;
+}
+
+/* Constrói uma subárvore com exatamente 'altura' níveis a partir de n chaves já ordenadas,
+   distribuindo as chaves igualmente entre os filhos (nenhum rebalanceamento posterior) */
+BTreeNode* btree_build_node(TreeNode** chaves, int n, int altura, bool raiz) {
+    BTreeNode* x = btree_node_create(altura == 1);
+    if (altura == 1) {
+        for (int i = 0; i < n; i++) {
+            x->chaves[i] = chaves[i];
+        }
+        x->n = n;
+        return x;
+    }
+    long long capFilho = btree_capacidade(altura - 1);
+    int c = (int) ((n + 1 + capFilho) / (capFilho + 1));
+    int minimo = raiz ? 2 : MIN_DEGREE;
+    if (c < minimo) {
+        c = minimo;
+    }
+    int total = n - (c - 1);
+    int base = total / c;
+    int resto = total % c;
+    int pos = 0;
+    for (int i = 0; i < c; i++) {
+        int m = base + (i < resto ? 1 : 0);
+        x->filhos[i] = btree_build_node(chaves + pos, m, altura - 1, false);
+        pos += m;
+        if (i < c - 1) {
+            x->chaves[i] = chaves[pos++];
+        }
+    }
+    x->n = c - 1;
+    return x;
+}
+
+/* Cria uma árvore B ordenada por cmp diretamente a partir de n chaves já ordenadas (carga em bloco) */
+BTree* btree_build_sorted(TreeNode** chaves, int n, BTreeCmp cmp) {
+    BTree* tree = btree_create_ordered(cmp);
+    if (n == 0) {
+        return tree;
+    }
+    int altura = 1;
+    while (btree_capacidade(altura) < n) {
+        altura++;
+    }
+    free(tree->raiz);
+    tree->raiz = btree_build_node(chaves, n, altura, true);
+    return tree;
+}
+
 /* Libera recursivamente todos os nós de uma árvore B (auxiliar para destruir diretório) */
 void btree_free_node(BTreeNode* x) {
     if (!x->folha) {
@@ -400,8 +573,461 @@ void btree_destroy(BTree* tree) {
     free(tree);
 }
 
+/* Vetor de entradas usado para coletar o conteúdo de uma árvore ou diretório em ordem */
+typedef struct VetorNos {
+    TreeNode** itens;
+    int n;
+} VetorNos;
+
+/* Callback auxiliar: acrescenta a entrada visitada ao vetor em ctx */
+void vetor_nos_visita(TreeNode* node, void* ctx) {
+    VetorNos* v = (VetorNos*) ctx;
+    v->itens[v->n++] = node;
+}
+
+/* Intercala em 'final' as entradas atuais com as alterações, todas ordenadas por cmp:
+   as entradas de 'remover' (que devem estar entre as atuais) são omitidas e as de 'inserir'
+   são acrescentadas. 'final' deve comportar na - nr + ni entradas. Retorna o total gerado. */
+int merge_sorted_nodes(TreeNode** atuais, int na, TreeNode** remover, int nr,
+                       TreeNode** inserir, int ni, BTreeCmp cmp, TreeNode** final) {
+    int i = 0, r = 0, j = 0, k = 0;
+    while (i < na || j < ni) {
+        if (i < na && r < nr && atuais[i] == remover[r]) {
+            i++;
+            r++;
+        } else if (j == ni || (i < na && cmp(atuais[i], inserir[j]) < 0)) {
+            final[k++] = atuais[i++];
+        } else {
+            final[k++] = inserir[j++];
+        }
+    }
+    return k;
+}
+
+/* Aplica à árvore (com 'total' chaves) as remoções e inserções dadas, ambas ordenadas por
+   tree->cmp, em uma única passada: intercala o percurso em ordem com as alterações e
+   reconstrói a árvore em bloco. As chaves a remover devem estar presentes. Retorna a nova árvore. */
+BTree* btree_merge_rebuild(BTree* tree, TreeNode** remover, int nr, TreeNode** inserir, int ni, int total) {
+    VetorNos atuais = { NULL, 0 };
+    atuais.itens = (TreeNode**) malloc((size_t) (total + 1) * sizeof(TreeNode*));
+    TreeNode** final = (TreeNode**) malloc((size_t) (total - nr + ni + 1) * sizeof(TreeNode*));
+    if (!atuais.itens || !final) {
+        fprintf(stderr, "Erro de alocação de memória ao reconstruir árvore B.\n");
+        exit(EXIT_FAILURE);
+    }
+    btree_foreach(tree, vetor_nos_visita, &atuais);
+
+    int k = merge_sorted_nodes(atuais.itens, atuais.n, remover, nr, inserir, ni, tree->cmp, final);
+    BTree* nova = btree_build_sorted(final, k, tree->cmp);
+    btree_destroy(tree);
+    free(atuais.itens);
+    free(final);
+    return nova;
+}
+
+/* Função de hash FNV-1a sobre o nome da entrada */
+uint64_t dir_hash_nome(const char* name) {
+    uint64_t h = 14695981039346656037ULL;
+    for (const unsigned char* p = (const unsigned char*) name; *p; p++) {
+        h ^= *p;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/* Cria um índice hash vazio com capacidade (potência de 2) para ao menos 'minimo' entradas */
+DirHash* dir_hash_create(size_t minimo) {
+    DirHash* h = (DirHash*) malloc(sizeof(DirHash));
+    if (!h) {
+        fprintf(stderr, "Erro de alocação de memória ao criar índice hash.\n");
+        exit(EXIT_FAILURE);
+    }
+    h->capacidade = 16;
+    while (h->capacidade < minimo * 2) {
+        h->capacidade *= 2;
+    }
+    h->slots = (TreeNode**) calloc(h->capacidade, sizeof(TreeNode*));
+    if (!h->slots) {
+        fprintf(stderr, "Erro de alocação de memória ao criar índice hash.\n");
+        exit(EXIT_FAILURE);
+    }
+    h->n = 0;
+    return h;
+}
+
+/* Libera o índice hash (as entradas pertencem ao diretório e não são liberadas) */
+void dir_hash_destroy(DirHash* h) {
+    if (!h) return;
+    free(h->slots);
+    free(h);
+}
+
+/* Retorna o índice do slot que contém 'name' ou do primeiro slot vazio da sequência de sondagem */
+size_t dir_hash_slot(const DirHash* h, const char* name) {
+    size_t mask = h->capacidade - 1;
+    size_t i = (size_t) dir_hash_nome(name) & mask;
+    while (h->slots[i] != NULL && strcmp(h->slots[i]->name, name) != 0) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+/* Busca uma entrada pelo nome no índice hash */
+TreeNode* dir_hash_find(const DirHash* h, const char* name) {
+    return h->slots[dir_hash_slot(h, name)];
+}
+
+/* Insere uma entrada no índice hash, dobrando a tabela quando a ocupação passa de 70% */
+void dir_hash_insert(DirHash* h, TreeNode* node) {
+    if ((h->n + 1) * 10 > h->capacidade * 7) {
+        TreeNode** antigos = h->slots;
+        size_t capAntiga = h->capacidade;
+        h->capacidade *= 2;
+        h->slots = (TreeNode**) calloc(h->capacidade, sizeof(TreeNode*));
+        if (!h->slots) {
+            fprintf(stderr, "Erro de alocação de memória ao expandir índice hash.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (size_t i = 0; i < capAntiga; i++) {
+            if (antigos[i] != NULL) {
+                h->slots[dir_hash_slot(h, antigos[i]->name)] = antigos[i];
+            }
+        }
+        free(antigos);
+    }
+    h->slots[dir_hash_slot(h, node->name)] = node;
+    h->n += 1;
+}
+
+/* Remove uma entrada do índice hash, reposicionando as seguintes (sem lápides) */
+void dir_hash_remove(DirHash* h, const char* name) {
+    size_t mask = h->capacidade - 1;
+    size_t i = dir_hash_slot(h, name);
+    if (h->slots[i] == NULL) {
+        return;
+    }
+    h->slots[i] = NULL;
+    h->n -= 1;
+    size_t j = i;
+    while (true) {
+        j = (j + 1) & mask;
+        if (h->slots[j] == NULL) {
+            break;
+        }
+        size_t k = (size_t) dir_hash_nome(h->slots[j]->name) & mask;
+        /* Mantém no lugar a entrada cujo slot ideal k está ciclicamente em (i, j] */
+        bool noLugar = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+        if (noLugar) {
+            continue;
+        }
+        h->slots[i] = h->slots[j];
+        h->slots[j] = NULL;
+        i = j;
+    }
+}
+
+/* Inicializa um diretório vazio na representação inline */
+void dir_init(Directory* dir, Directory* parent) {
+    dir->modo = DIR_INLINE;
+    dir->n = 0;
+    dir->tree = NULL;
+    dir->hash = NULL;
+    dir->parent = parent;
+    dir->name = NULL;
+}
+
+/* Busca binária no vetor inline; retorna a posição de 'name' ou onde ele seria inserido */
+int dir_inline_pos(const Directory* dir, const char* name, bool* encontrado) {
+    int lo = 0, hi = dir->n;
+    *encontrado = false;
+    while (lo < hi) {
+        int meio = (lo + hi) / 2;
+        int c = strcmp(name, dir->inline_chaves[meio]->name);
+        if (c == 0) {
+            *encontrado = true;
+            return meio;
+        }
+        if (c < 0) {
+            hi = meio;
+        } else {
+            lo = meio + 1;
+        }
+    }
+    return lo;
+}
+
+/* Busca uma entrada (arquivo ou diretório) pelo nome, qualquer que seja a representação */
+TreeNode* dir_lookup(const Directory* dir, const char* name) {
+    if (dir->modo == DIR_INLINE) {
+        bool encontrado;
+        int pos = dir_inline_pos(dir, name, &encontrado);
+        return encontrado ? dir->inline_chaves[pos] : NULL;
+    }
+    if (dir->hash != NULL) {
+        return dir_hash_find(dir->hash, name);
+    }
+    return btree_search(dir->tree, name);
+}
+
+/* Percorre as entradas do diretório em ordem alfabética */
+void dir_foreach(const Directory* dir, void (*visita)(TreeNode*, void*), void* ctx) {
+    if (dir->modo == DIR_INLINE) {
+        for (int i = 0; i < dir->n; i++) {
+            visita(dir->inline_chaves[i], ctx);
+        }
+    } else {
+        btree_foreach(dir->tree, visita, ctx);
+    }
+}
+
+/* Callback auxiliar: insere a entrada visitada no índice hash passado em ctx */
+void dir_hash_visita(TreeNode* node, void* ctx) {
+    dir_hash_insert((DirHash*) ctx, node);
+}
+
+/* Callback auxiliar: acrescenta a entrada visitada ao vetor inline do diretório em ctx */
+void dir_inline_visita(TreeNode* node, void* ctx) {
+    Directory* dir = (Directory*) ctx;
+    dir->inline_chaves[dir->n++] = node;
+}
+
+/* Insere uma entrada no diretório (assume que o nome ainda não existe),
+   promovendo a representação quando os limiares são ultrapassados */
+void dir_insert(Directory* dir, TreeNode* node) {
+    if (dir->modo == DIR_INLINE) {
+        if (dir->n < DIR_INLINE_MAX) {
+            bool encontrado;
+            int pos = dir_inline_pos(dir, node->name, &encontrado);
+            memmove(&dir->inline_chaves[pos + 1], &dir->inline_chaves[pos],
+                    (size_t) (dir->n - pos) * sizeof(TreeNode*));
+            dir->inline_chaves[pos] = node;
+            dir->n += 1;
+            return;
+        }
+        dir->tree = btree_create();
+        for (int i = 0; i < dir->n; i++) {
+            btree_insert(dir->tree, dir->inline_chaves[i]);
+        }
+        dir->modo = DIR_BTREE;
+    }
+    btree_insert(dir->tree, node);
+    dir->n += 1;
+    if (dir->hash != NULL) {
+        dir_hash_insert(dir->hash, node);
+    } else if (dir->n >= DIR_HASH_PROMOTE) {
+        dir->hash = dir_hash_create((size_t) dir->n);
+        btree_foreach(dir->tree, dir_hash_visita, dir->hash);
+    }
+}
+
+/* Atualiza contagem, índice hash e representação após remover 'name' da Árvore B */
+void dir_shrink(Directory* dir, const char* name) {
+    dir->n -= 1;
+    if (dir->hash != NULL) {
+        if (dir->n <= DIR_HASH_DEMOTE) {
+            dir_hash_destroy(dir->hash);
+            dir->hash = NULL;
+        } else {
+            dir_hash_remove(dir->hash, name);
+        }
+    }
+    if (dir->n <= DIR_INLINE_DEMOTE) {
+        BTree* tree = dir->tree;
+        dir->n = 0;
+        btree_foreach(tree, dir_inline_visita, dir);
+        btree_destroy(tree);
+        dir->tree = NULL;
+        dir->modo = DIR_INLINE;
+    }
+}
+
+/* Remove do diretório uma entrada que se sabe presente (uma única descida na Árvore B),
+   rebaixando a representação quando o diretório encolhe */
+void dir_remove_entry(Directory* dir, TreeNode* entry) {
+    if (dir->modo == DIR_INLINE) {
+        bool encontrado;
+        int pos = dir_inline_pos(dir, entry->name, &encontrado);
+        memmove(&dir->inline_chaves[pos], &dir->inline_chaves[pos + 1],
+                (size_t) (dir->n - pos - 1) * sizeof(TreeNode*));
+        dir->n -= 1;
+        return;
+    }
+    btree_remove_present(dir->tree, entry);
+    dir_shrink(dir, entry->name);
+}
+
+/* Libera as estruturas de índice do diretório (não libera as entradas nem o próprio diretório) */
+void dir_destroy_index(Directory* dir) {
+    btree_destroy(dir->tree);
+    dir_hash_destroy(dir->hash);
+    dir->tree = NULL;
+    dir->hash = NULL;
+    dir->n = 0;
+    dir->modo = DIR_INLINE;
+}
+
+/* Efeito líquido de uma transação sobre um nome de um diretório */
+typedef struct DirEfeito {
+    TreeNode* antigo;    /* entrada existente a remover ou substituir (ou NULL) */
+    TreeNode* novo;      /* entrada a inserir no lugar (ou NULL) */
+} DirEfeito;
+
+/* Aplica ao diretório m efeitos ordenados por nome. Lotes pequenos em relação ao diretório
+   são aplicados um a um; os demais fazem uma única passada que intercala as entradas
+   existentes com os efeitos e reconstrói a representação em bloco. */
+void dir_apply_sorted(Directory* dir, const DirEfeito* efeitos, int m) {
+    if ((long long) m * BATCH_REBUILD_RATIO < dir->n) {
+        for (int i = 0; i < m; i++) {
+            if (efeitos[i].antigo) {
+                dir_remove_entry(dir, efeitos[i].antigo);
+            }
+            if (efeitos[i].novo) {
+                dir_insert(dir, efeitos[i].novo);
+            }
+        }
+        return;
+    }
+
+    VetorNos atuais = { NULL, 0 };
+    atuais.itens = (TreeNode**) malloc((size_t) (dir->n + 1) * sizeof(TreeNode*));
+    TreeNode** final = (TreeNode**) malloc((size_t) (dir->n + m + 1) * sizeof(TreeNode*));
+    TreeNode** remover = (TreeNode**) malloc((size_t) (m + 1) * sizeof(TreeNode*));
+    TreeNode** inserir = (TreeNode**) malloc((size_t) (m + 1) * sizeof(TreeNode*));
+    if (!atuais.itens || !final || !remover || !inserir) {
+        fprintf(stderr, "Erro de alocação de memória ao aplicar transação.\n");
+        exit(EXIT_FAILURE);
+    }
+    dir_foreach(dir, vetor_nos_visita, &atuais);
+    int nr = 0, ni = 0;
+    for (int i = 0; i < m; i++) {
+        if (efeitos[i].antigo) {
+            remover[nr++] = efeitos[i].antigo;
+        }
+        if (efeitos[i].novo) {
+            inserir[ni++] = efeitos[i].novo;
+        }
+    }
+    int k = merge_sorted_nodes(atuais.itens, atuais.n, remover, nr, inserir, ni, btree_cmp_nome, final);
+
+    bool usaInline = (dir->modo == DIR_INLINE) ? k <= DIR_INLINE_MAX : k <= DIR_INLINE_DEMOTE;
+    bool usaHash = !usaInline && (dir->hash != NULL ? k > DIR_HASH_DEMOTE : k >= DIR_HASH_PROMOTE);
+    dir_destroy_index(dir);
+    if (usaInline) {
+        memcpy(dir->inline_chaves, final, (size_t) k * sizeof(TreeNode*));
+    } else {
+        dir->tree = btree_build_sorted(final, k, btree_cmp_nome);
+        dir->modo = DIR_BTREE;
+        if (usaHash) {
+            dir->hash = dir_hash_create((size_t) k);
+            for (int x = 0; x < k; x++) {
+                dir_hash_insert(dir->hash, final[x]);
+            }
+        }
+    }
+    dir->n = k;
+    free(atuais.itens);
+    free(final);
+    free(remover);
+    free(inserir);
+}
+
+/* Índices secundários globais sobre os metadados de todos os arquivos do sistema */
+typedef struct FileIndex {
+    BTree* por_tamanho;   /* ordenado por (tamanho, nó) */
+    BTree* por_mtime;     /* ordenado por (modificação, nó) */
+    int n;                /* total de arquivos indexados */
+} FileIndex;
+
+FileIndex file_index = { NULL, NULL, 0 };
+
+/* Chave numérica do índice por tamanho */
+long long file_chave_tamanho(const TreeNode* node) {
+    return (long long) node->data.file->size;
+}
+
+/* Chave numérica do índice por data de modificação */
+long long file_chave_mtime(const TreeNode* node) {
+    return (long long) node->data.file->modificado;
+}
+
+/* Compara pela chave numérica e desempata pelo endereço do nó, mantendo as chaves únicas */
+int file_cmp_chave(const TreeNode* a, const TreeNode* b, long long (*chave)(const TreeNode*)) {
+    long long ka = chave(a), kb = chave(b);
+    if (ka != kb) {
+        return ka < kb ? -1 : 1;
+    }
+    uintptr_t pa = (uintptr_t) a, pb = (uintptr_t) b;
+    return (pa > pb) - (pa < pb);
+}
+
+/* Ordenação do índice por tamanho */
+int file_cmp_tamanho(const TreeNode* a, const TreeNode* b) {
+    return file_cmp_chave(a, b, file_chave_tamanho);
+}
+
+/* Ordenação do índice por data de modificação */
+int file_cmp_mtime(const TreeNode* a, const TreeNode* b) {
+    return file_cmp_chave(a, b, file_chave_mtime);
+}
+
+/* Cria os índices secundários vazios */
+void file_index_init() {
+    file_index.por_tamanho = btree_create_ordered(file_cmp_tamanho);
+    file_index.por_mtime = btree_create_ordered(file_cmp_mtime);
+}
+
+/* Registra um arquivo nos índices secundários */
+void file_index_add(TreeNode* node) {
+    btree_insert(file_index.por_tamanho, node);
+    btree_insert(file_index.por_mtime, node);
+    file_index.n += 1;
+}
+
+/* Retira dos índices secundários um arquivo indexado (deve ser chamado antes de alterar tamanho ou datas) */
+void file_index_remove(TreeNode* node) {
+    btree_remove_present(file_index.por_tamanho, node);
+    btree_remove_present(file_index.por_mtime, node);
+    file_index.n -= 1;
+}
+
+/* Adaptadores de file_cmp_tamanho e file_cmp_mtime para qsort sobre vetores de TreeNode* */
+int file_qsort_tamanho(const void* a, const void* b) {
+    return file_cmp_tamanho(*(TreeNode* const*) a, *(TreeNode* const*) b);
+}
+
+int file_qsort_mtime(const void* a, const void* b) {
+    return file_cmp_mtime(*(TreeNode* const*) a, *(TreeNode* const*) b);
+}
+
+/* Aplica a um índice secundário um lote de remoções (presentes) e inserções: uma a uma se o
+   lote é pequeno em relação ao índice, senão ordenando o lote e reconstruindo o índice em bloco */
+BTree* file_index_apply_one(BTree* tree, int (*ordem)(const void*, const void*),
+                            TreeNode** remover, int nr, TreeNode** inserir, int ni) {
+    if ((long long) (nr + ni) * BATCH_REBUILD_RATIO < file_index.n) {
+        for (int i = 0; i < nr; i++) {
+            btree_remove_present(tree, remover[i]);
+        }
+        for (int i = 0; i < ni; i++) {
+            btree_insert(tree, inserir[i]);
+        }
+        return tree;
+    }
+    qsort(remover, (size_t) nr, sizeof(TreeNode*), ordem);
+    qsort(inserir, (size_t) ni, sizeof(TreeNode*), ordem);
+    return btree_merge_rebuild(tree, remover, nr, inserir, ni, file_index.n);
+}
+
+/* Aplica aos dois índices secundários as remoções e inserções de uma transação */
+void file_index_apply(TreeNode** remover, int nr, TreeNode** inserir, int ni) {
+    file_index.por_tamanho = file_index_apply_one(file_index.por_tamanho, file_qsort_tamanho,
+                                                  remover, nr, inserir, ni);
+    file_index.por_mtime = file_index_apply_one(file_index.por_mtime, file_qsort_mtime,
+                                                remover, nr, inserir, ni);
+    file_index.n += ni - nr;
+}
+
 /* Cria um novo TreeNode de arquivo .txt com nome e conteúdo especificados */
-TreeNode* create_txt_file_node(const char* name, const char* content) {
+TreeNode* create_txt_file_node(const char* name, const char* content, Directory* parent) {
     // Aloca e configura a estrutura File
     File* file = (File*) malloc(sizeof(File));
     if (!file) {
@@ -434,6 +1060,9 @@ TreeNode* create_txt_file_node(const char* name, const char* content) {
     } else {
         file->content = NULL;
     }
+    file->criado = time(NULL);
+    file->modificado = file->criado;
+    file->parent = parent;
     TreeNode* node = (TreeNode*) malloc(sizeof(TreeNode));
     if (!node) {
         fprintf(stderr, "Erro de alocação de memória para TreeNode de arquivo.\n");
@@ -455,19 +1084,17 @@ TreeNode* create_directory_node(const char* name, Directory* parent) {
         fprintf(stderr, "Erro de alocação de memória para Directory.\n");
         return NULL;
     }
-    dir->parent = parent;
-    dir->tree = btree_create(); 
+    dir_init(dir, parent);
     TreeNode* node = (TreeNode*) malloc(sizeof(TreeNode));
     if (!node) {
         fprintf(stderr, "Erro de alocação de memória para TreeNode de diretório.\n");
-        btree_destroy(dir->tree);
         free(dir);
         return NULL;
     }
     char* nomeCopia = (char*) malloc(strlen(name) + 1);
     if (!nomeCopia) {
         fprintf(stderr, "Erro de alocação de memória para nome do diretório.\n");
-        btree_destroy(dir->tree);
+        free(node);
         free(dir);
         return NULL;
     }
@@ -479,6 +1106,15 @@ TreeNode* create_directory_node(const char* name, Directory* parent) {
     return node;
 }
 
+/* Libera um TreeNode de arquivo e todos os seus dados */
+void free_file_node(TreeNode* node) {
+    File* file = node->data.file;
+    free(file->content);
+    free(file);
+    free(node->name);
+    free(node);
+}
+
 /* Insere (cria) um novo arquivo .txt no diretório atual */
 bool create_txt_file(Directory* currentDir, const char* name, const char* content) {
     const char* ext = strrchr(name, '.');
@@ -486,22 +1122,23 @@ bool create_txt_file(Directory* currentDir, const char* name, const char* conten
         printf("Erro: apenas arquivos .txt podem ser criados.\n");
         return false;
     }
-    if (btree_search(currentDir->tree, name) != NULL) {
+    if (dir_lookup(currentDir, name) != NULL) {
         printf("Erro: já existe um arquivo ou diretório com o nome \"%s\".\n", name);
         return false;
     }
-    TreeNode* node = create_txt_file_node(name, content);
+    TreeNode* node = create_txt_file_node(name, content, currentDir);
     if (!node) {
         printf("Erro ao criar arquivo \"%s\".\n", name);
         return false;
     }
-    btree_insert(currentDir->tree, node);
+    dir_insert(currentDir, node);
+    file_index_add(node);
     return true;
 }
 
 /* Insere (cria) um novo diretório no diretório atual */
 bool create_directory(Directory* currentDir, const char* name) {
-    if (btree_search(currentDir->tree, name) != NULL) {
+    if (dir_lookup(currentDir, name) != NULL) {
         printf("Erro: já existe um arquivo ou diretório com o nome \"%s\".\n", name);
         return false;
     }
@@ -510,13 +1147,13 @@ bool create_directory(Directory* currentDir, const char* name) {
         printf("Erro ao criar diretório \"%s\".\n", name);
         return false;
     }
-    btree_insert(currentDir->tree, node);
+    dir_insert(currentDir, node);
     return true;
 }
 
 /* Remove um arquivo .txt do diretório atual */
 bool delete_txt_file(Directory* currentDir, const char* name) {
-    TreeNode* node = btree_search(currentDir->tree, name);
+    TreeNode* node = dir_lookup(currentDir, name);
     if (node == NULL) {
         printf("Erro: arquivo \"%s\" não encontrado.\n", name);
         return false;
@@ -525,22 +1162,15 @@ bool delete_txt_file(Directory* currentDir, const char* name) {
         printf("Erro: \"%s\" não é um arquivo.\n", name);
         return false;
     }
-    TreeNode* removido = btree_delete(currentDir->tree, name);
-    if (!removido) {
-        printf("Erro ao remover arquivo \"%s\".\n", name);
-        return false;
-    }
-    File* file = removido->data.file;
-    free(file->content);
-    free(file);
-    free(removido->name);
-    free(removido);
+    dir_remove_entry(currentDir, node);
+    file_index_remove(node);
+    free_file_node(node);
     return true;
 }
 
 /* Remove um diretório vazio do diretório atual */
 bool delete_directory(Directory* currentDir, const char* name) {
-    TreeNode* node = btree_search(currentDir->tree, name);
+    TreeNode* node = dir_lookup(currentDir, name);
     if (node == NULL) {
         printf("Erro: diretório \"%s\" não encontrado.\n", name);
         return false;
@@ -550,7 +1180,7 @@ bool delete_directory(Directory* currentDir, const char* name) {
         return false;
     }
     Directory* dir = node->data.directory;
-    if (dir->tree->raiz->n != 0) {
+    if (dir->n != 0) {
         printf("Erro: diretório \"%s\" não está vazio.\n", name);
         return false;
     }
@@ -559,18 +1189,222 @@ bool delete_directory(Directory* currentDir, const char* name) {
         return false;
     }
     
-    TreeNode* removido = btree_delete(currentDir->tree, name);
-    if (!removido) {
-        printf("Erro ao remover diretório \"%s\".\n", name);
-        return false;
-    }
-    btree_destroy(dir->tree);
-    free(removido->name);
+    dir_remove_entry(currentDir, node);
+    dir_destroy_index(dir);
+    free(node->name);
     free(dir);
-    free(removido);
+    free(node);
+    return true;
+}
+
+/* Tipos de operação agrupáveis em uma transação */
+typedef enum { BATCH_CREATE, BATCH_DELETE } BatchOpType;
+
+/* Operação pendente de uma transação */
+typedef struct BatchOp {
+    BatchOpType tipo;
+    Directory* dir;
+    char* name;
+    char* content;      /* apenas BATCH_CREATE */
+    size_t seq;         /* ordem de chegada, preservada entre operações sobre o mesmo nome */
+    TreeNode* node;     /* nó preparado na validação (BATCH_CREATE) */
+} BatchOp;
+
+/* Transação: lista de operações acumuladas entre 'iniciar' e 'confirmar' */
+typedef struct Batch {
+    BatchOp* ops;
+    size_t n;
+    size_t capacidade;
+    bool ativa;
+} Batch;
+
+/* Inicializa uma transação inativa e vazia */
+void batch_init(Batch* batch) {
+    batch->ops = NULL;
+    batch->n = 0;
+    batch->capacidade = 0;
+    batch->ativa = false;
+}
+
+/* Descarta todas as operações pendentes e encerra a transação */
+void batch_clear(Batch* batch) {
+    for (size_t i = 0; i < batch->n; i++) {
+        free(batch->ops[i].name);
+        free(batch->ops[i].content);
+    }
+    free(batch->ops);
+    batch_init(batch);
+}
+
+/* Acrescenta uma operação à transação (o conteúdo pode ser NULL) */
+void batch_add(Batch* batch, BatchOpType tipo, Directory* dir, const char* name, const char* content) {
+    if (batch->n == batch->capacidade) {
+        batch->capacidade = batch->capacidade ? batch->capacidade * 2 : 64;
+        batch->ops = (BatchOp*) realloc(batch->ops, batch->capacidade * sizeof(BatchOp));
+        if (!batch->ops) {
+            fprintf(stderr, "Erro de alocação de memória ao registrar operação da transação.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    BatchOp* op = &batch->ops[batch->n];
+    op->tipo = tipo;
+    op->dir = dir;
+    op->seq = batch->n;
+    op->node = NULL;
+    op->content = NULL;
+    op->name = (char*) malloc(strlen(name) + 1);
+    if (content) {
+        op->content = (char*) malloc(strlen(content) + 1);
+    }
+    if (!op->name || (content && !op->content)) {
+        fprintf(stderr, "Erro de alocação de memória ao registrar operação da transação.\n");
+        exit(EXIT_FAILURE);
+    }
+    strcpy(op->name, name);
+    if (content) {
+        strcpy(op->content, content);
+    }
+    batch->n += 1;
+}
+
+/* Ordena as operações por diretório, nome e ordem de chegada */
+int batch_op_cmp(const void* a, const void* b) {
+    const BatchOp* x = (const BatchOp*) a;
+    const BatchOp* y = (const BatchOp*) b;
+    uintptr_t dx = (uintptr_t) x->dir, dy = (uintptr_t) y->dir;
+    if (dx != dy) {
+        return dx < dy ? -1 : 1;
+    }
+    int c = strcmp(x->name, y->name);
+    if (c != 0) {
+        return c;
+    }
+    return (x->seq > y->seq) - (x->seq < y->seq);
+}
+
+/* Valida a sequência de operações de um mesmo nome a partir do estado atual, preparando os
+   nós a criar, e devolve o efeito líquido. Retorna false (sem alterar o sistema) em caso de erro. */
+bool batch_validate_group(BatchOp* ops, size_t n, DirEfeito* efeito) {
+    TreeNode* original = dir_lookup(ops[0].dir, ops[0].name);
+    TreeNode* atual = original;
+    BatchOp* criador = NULL;    /* operação dona do nó em 'atual', se ele foi preparado aqui */
+    for (size_t i = 0; i < n; i++) {
+        BatchOp* op = &ops[i];
+        if (op->tipo == BATCH_CREATE) {
+            const char* ext = strrchr(op->name, '.');
+            if (!ext || strcmp(ext, ".txt") != 0) {
+                printf("Erro: apenas arquivos .txt podem ser criados.\n");
+                return false;
+            }
+            if (atual != NULL) {
+                printf("Erro: já existe um arquivo ou diretório com o nome \"%s\".\n", op->name);
+                return false;
+            }
+            op->node = create_txt_file_node(op->name, op->content, op->dir);
+            if (!op->node) {
+                printf("Erro ao criar arquivo \"%s\".\n", op->name);
+                return false;
+            }
+            atual = op->node;
+            criador = op;
+        } else {
+            if (atual == NULL) {
+                printf("Erro: arquivo \"%s\" não encontrado.\n", op->name);
+                return false;
+            }
+            if (atual->type != FILE_TYPE) {
+                printf("Erro: \"%s\" não é um arquivo.\n", op->name);
+                return false;
+            }
+            if (criador != NULL) {
+                free_file_node(criador->node);
+                criador->node = NULL;
+                criador = NULL;
+            }
+            atual = NULL;
+        }
+    }
+    efeito->antigo = (atual == original) ? NULL : original;
+    efeito->novo = (atual == original) ? NULL : atual;
     return true;
 }
 
+/* Confirma a transação de forma atômica. Primeiro todas as operações são validadas e os
+   arquivos novos são preparados; se alguma falhar, nada é aplicado. Depois as operações,
+   ordenadas por diretório e nome, são aplicadas com uma passada por diretório. */
+bool batch_commit(Batch* batch) {
+    size_t total = batch->n;
+    if (total == 0) {
+        printf("Transação confirmada: 0 operações aplicadas.\n");
+        batch_clear(batch);
+        return true;
+    }
+    qsort(batch->ops, batch->n, sizeof(BatchOp), batch_op_cmp);
+    DirEfeito* efeitos = (DirEfeito*) malloc((batch->n + 1) * sizeof(DirEfeito));
+    Directory** dirs = (Directory**) malloc((batch->n + 1) * sizeof(Directory*));
+    if (!efeitos || !dirs) {
+        fprintf(stderr, "Erro de alocação de memória ao confirmar transação.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t m = 0;
+    bool ok = true;
+    for (size_t i = 0; i < batch->n && ok; ) {
+        size_t j = i + 1;
+        while (j < batch->n && batch->ops[j].dir == batch->ops[i].dir &&
+               strcmp(batch->ops[j].name, batch->ops[i].name) == 0) {
+            j++;
+        }
+        ok = batch_validate_group(&batch->ops[i], j - i, &efeitos[m]);
+        if (ok && (efeitos[m].antigo || efeitos[m].novo)) {
+            dirs[m++] = batch->ops[i].dir;
+        }
+        i = j;
+    }
+
+    if (!ok) {
+        for (size_t i = 0; i < batch->n; i++) {
+            if (batch->ops[i].node) {
+                free_file_node(batch->ops[i].node);
+            }
+        }
+        printf("Transação desfeita: nenhuma das %zu operações foi aplicada.\n", total);
+    } else {
+        TreeNode** removidos = (TreeNode**) malloc((m + 1) * sizeof(TreeNode*));
+        TreeNode** inseridos = (TreeNode**) malloc((m + 1) * sizeof(TreeNode*));
+        if (!removidos || !inseridos) {
+            fprintf(stderr, "Erro de alocação de memória ao confirmar transação.\n");
+            exit(EXIT_FAILURE);
+        }
+        int nr = 0, ni = 0;
+        for (size_t i = 0; i < m; ) {
+            size_t j = i;
+            while (j < m && dirs[j] == dirs[i]) {
+                if (efeitos[j].antigo) {
+                    removidos[nr++] = efeitos[j].antigo;
+                }
+                if (efeitos[j].novo) {
+                    inseridos[ni++] = efeitos[j].novo;
+                }
+                j++;
+            }
+            dir_apply_sorted(dirs[i], &efeitos[i], (int) (j - i));
+            i = j;
+        }
+        file_index_apply(removidos, nr, inseridos, ni);
+        for (int i = 0; i < nr; i++) {
+            free_file_node(removidos[i]);
+        }
+        free(removidos);
+        free(inseridos);
+        printf("Transação confirmada: %zu operações aplicadas.\n", total);
+    }
+    free(efeitos);
+    free(dirs);
+    batch_clear(batch);
+    return ok;
+}
+
 /* Altera o diretório atual (simulação do comando 'cd') */
 Directory* change_directory(Directory* currentDir, const char* name) {
     if (strcmp(name, "..") == 0) {
@@ -586,7 +1420,7 @@ Directory* change_directory(Directory* currentDir, const char* name) {
         }
         return temp;
     } else {
-        TreeNode* node = btree_search(currentDir->tree, name);
+        TreeNode* node = dir_lookup(currentDir, name);
         if (node == NULL || node->type != DIRECTORY_TYPE) {
             printf("Erro: diretório \"%s\" não encontrado.\n", name);
             return currentDir;
@@ -595,35 +1429,127 @@ Directory* change_directory(Directory* currentDir, const char* name) {
     }
 }
 
+/* Callback de listagem: imprime o nome da entrada (diretórios com '/' ao final) */
+void print_entry_name(TreeNode* entry, void* ctx) {
+    (void) ctx;
+    if (entry->type == DIRECTORY_TYPE) {
+        printf("%s/\n", entry->name);
+    } else {
+        printf("%s\n", entry->name);
+    }
+}
+
 /* Lista o conteúdo do diretório atual (arquivos e subdiretórios) */
 void list_directory_contents(Directory* currentDir) {
-    BTreeNode* root = currentDir->tree->raiz;
-    if (root->n == 0) {
+    if (currentDir->n == 0) {
         printf("[Diretório vazio]\n");
     } else {
-        btree_traverse(currentDir->tree);
+        dir_foreach(currentDir, print_entry_name, NULL);
     }
 }
 
+/* Contexto da impressão recursiva do arquivo de imagem */
+typedef struct ImageCtx {
+    int indent;
+    FILE* f;
+} ImageCtx;
+
 /* Função auxiliar recursiva para imprimir entradas em ordem no arquivo de imagem */
-void print_entries_rec(BTreeNode* node, int indent, FILE* f) {
-    for (int i = 0; i < node->n; i++) {
-        if (!node->folha) {
-            print_entries_rec(node->filhos[i], indent, f);
-        }
-        for (int j = 0; j < indent; j++) {
-            fprintf(f, "    ");
-        }
-        TreeNode* entry = node->chaves[i];
-        if (entry->type == DIRECTORY_TYPE) {
-            fprintf(f, "%s/\n", entry->name);
-            print_entries_rec(entry->data.directory->tree->raiz, indent + 1, f);
-        } else {
-            fprintf(f, "%s (tamanho=%zu bytes)\n", entry->name, entry->data.file->size);
+void print_entries_rec(TreeNode* entry, void* ctx) {
+    ImageCtx* img = (ImageCtx*) ctx;
+    for (int j = 0; j < img->indent; j++) {
+        fprintf(img->f, "    ");
+    }
+    if (entry->type == DIRECTORY_TYPE) {
+        fprintf(img->f, "%s/\n", entry->name);
+        ImageCtx sub = { img->indent + 1, img->f };
+        dir_foreach(entry->data.directory, print_entries_rec, &sub);
+    } else {
+        fprintf(img->f, "%s (tamanho=%zu bytes)\n", entry->name, entry->data.file->size);
+    }
+}
+
+/* Imprime o caminho absoluto de um diretório (vazio para a raiz) */
+void print_directory_path(const Directory* dir) {
+    if (dir == NULL || dir->parent == NULL) {
+        return;
+    }
+    print_directory_path(dir->parent);
+    printf("/%s", dir->name);
+}
+
+/* Formata um instante como data local, ou como o valor bruto de time_t se a conversão falhar */
+void format_time(time_t instante, char* destino, size_t tamanho) {
+    struct tm* local = localtime(&instante);
+    if (local == NULL || strftime(destino, tamanho, "%Y-%m-%d %H:%M:%S", local) == 0) {
+        snprintf(destino, tamanho, "%lld", (long long) instante);
+    }
+}
+
+/* Callback da busca: imprime caminho, tamanho e datas de criação e modificação do arquivo */
+void print_find_result(TreeNode* entry, void* ctx) {
+    File* file = entry->data.file;
+    char criado[32], modificado[32];
+    format_time(file->criado, criado, sizeof(criado));
+    format_time(file->modificado, modificado, sizeof(modificado));
+    print_directory_path(file->parent);
+    printf("/%s (tamanho=%zu bytes, criado=%s, modificado=%s)\n", file->name, file->size, criado, modificado);
+    *(int*) ctx += 1;
+}
+
+/* Converte um valor com sufixo opcional; 'sufixos' lista as letras aceitas e 'fatores' seus multiplicadores */
+bool parse_quantidade(const char* texto, const char* sufixos, const long long* fatores, long long* valor) {
+    char* fim;
+    long long v = strtoll(texto, &fim, 10);
+    if (fim == texto || v < 0) {
+        return false;
+    }
+    if (*fim != '\0') {
+        const char* s = strchr(sufixos, *fim);
+        if (s == NULL || *(fim + 1) != '\0') {
+            return false;
+        }
+        long long fator = fatores[s - sufixos];
+        if (v > LLONG_MAX / fator) {
+            return false;
+        }
+        v *= fator;
+    }
+    *valor = v;
+    return true;
+}
+
+/* Busca arquivos pelos índices secundários:
+   "tamanho <min> [max]" (bytes, aceita sufixos K e M) ou "modificado <duração>" (aceita s, m, h, d) */
+void find_files(const char* criterio, const char* args) {
+    static const long long fatoresTamanho[] = { 1024LL, 1024LL * 1024LL };
+    static const long long fatoresTempo[] = { 1LL, 60LL, 3600LL, 86400LL };
+    char a[64] = "", b[64] = "";
+    int n = args ? sscanf(args, "%63s %63s", a, b) : 0;
+    int encontrados = 0;
+
+    if (strcmp(criterio, "tamanho") == 0 || strcmp(criterio, "size") == 0) {
+        long long min, max = LLONG_MAX;
+        if (n < 1 || !parse_quantidade(a, "KM", fatoresTamanho, &min) ||
+            (n >= 2 && !parse_quantidade(b, "KM", fatoresTamanho, &max))) {
+            printf("Uso: buscar tamanho <min>[K|M] [max[K|M]]\n");
+            return;
+        }
+        btree_range(file_index.por_tamanho, min, max, file_chave_tamanho, print_find_result, &encontrados);
+    } else if (strcmp(criterio, "modificado") == 0 || strcmp(criterio, "mtime") == 0) {
+        long long janela;
+        if (n < 1 || !parse_quantidade(a, "smhd", fatoresTempo, &janela)) {
+            printf("Uso: buscar modificado <duracao>[s|m|h|d]\n");
+            return;
         }
+        long long agora = (long long) time(NULL);
+        btree_range(file_index.por_mtime, agora - janela, agora, file_chave_mtime, print_find_result, &encontrados);
+    } else {
+        printf("Critério de busca não reconhecido: %s (use tamanho ou modificado)\n", criterio);
+        return;
     }
-    if (!node->folha) {
-        print_entries_rec(node->filhos[node->n], indent, f);
+    if (encontrados == 0) {
+        printf("[Nenhum arquivo encontrado]\n");
     }
 }
 
@@ -635,24 +1561,28 @@ void save_filesystem_image(Directory* rootDir, const char* filename) {
         return;
     }
     fprintf(f, "/\n");
-    print_entries_rec(rootDir->tree->raiz, 1, f);
+    ImageCtx img = { 1, f };
+    dir_foreach(rootDir, print_entries_rec, &img);
     fclose(f);
 }
 
 
 int main() {
     Directory* root = (Directory*) malloc(sizeof(Directory));
-    root->parent = NULL;
-    root->tree = btree_create();
-    root->name = NULL;
+    dir_init(root, NULL);
+    file_index_init();
     Directory* current = root;
+    Batch batch;
+    batch_init(&batch);
     char input[4096];
     printf("Sistema de Arquivos Virtual iniciado. Diretório atual: raiz (/) \n");
     printf("Comandos disponíveis: criar_arquivo <nome.txt> <conteudo>, criar_pasta <nome>, ");
-    printf("remover_arquivo <nome.txt>, remover_pasta <nome>, cd <dir>, cd .., ls, sair\n");
+    printf("remover_arquivo <nome.txt>, remover_pasta <nome>, cd <dir>, cd .., ls, ");
+    printf("buscar <tamanho|modificado> <args>, iniciar, confirmar, cancelar, sair\n");
 
     while (true) {
-        printf("\n%s> ", (current->parent == NULL ? "/" : current->name));
+        printf("\n%s%s> ", (current->parent == NULL ? "/" : current->name),
+               (batch.ativa ? " [transação]" : ""));
         if (!fgets(input, sizeof(input), stdin)) {
             break; 
         }
@@ -681,6 +1611,28 @@ int main() {
             } else {
                 printf("Uso: cd <diretorio>\n");
             }
+        } else if (strcmp(cmd, "iniciar") == 0 || strcmp(cmd, "begin") == 0) {
+            if (batch.ativa) {
+                printf("Erro: já existe uma transação em andamento.\n");
+            } else {
+                batch.ativa = true;
+            }
+        } else if (strcmp(cmd, "confirmar") == 0 || strcmp(cmd, "commit") == 0) {
+            if (batch.ativa) {
+                batch_commit(&batch);
+            } else {
+                printf("Erro: nenhuma transação em andamento.\n");
+            }
+        } else if (strcmp(cmd, "cancelar") == 0 || strcmp(cmd, "abort") == 0) {
+            if (batch.ativa) {
+                printf("Transação cancelada: %zu operações descartadas.\n", batch.n);
+                batch_clear(&batch);
+            } else {
+                printf("Erro: nenhuma transação em andamento.\n");
+            }
+        } else if (batch.ativa && (strcmp(cmd, "criar_pasta") == 0 || strcmp(cmd, "mkdir") == 0 ||
+                                   strcmp(cmd, "remover_pasta") == 0 || strcmp(cmd, "rmdir") == 0)) {
+            printf("Erro: criação e remoção de diretórios não são permitidas durante uma transação.\n");
         } else if (strcmp(cmd, "criar_pasta") == 0 || strcmp(cmd, "mkdir") == 0) {
             if (count >= 2) {
                 create_directory(current, arg1);
@@ -694,22 +1646,37 @@ int main() {
                 printf("Uso: remover_pasta <nome>\n");
             }
         } else if (strcmp(cmd, "criar_arquivo") == 0 || strcmp(cmd, "touch") == 0) {
-            if (count >= 3) {
+            if (count >= 3 && batch.ativa) {
+                batch_add(&batch, BATCH_CREATE, current, arg1, arg2);
+            } else if (count >= 3) {
                 create_txt_file(current, arg1, arg2);
             } else {
                 printf("Uso: criar_arquivo <nome.txt> <conteudo>\n");
             }
         } else if (strcmp(cmd, "remover_arquivo") == 0 || strcmp(cmd, "rm") == 0) {
-            if (count >= 2) {
+            if (count >= 2 && batch.ativa) {
+                batch_add(&batch, BATCH_DELETE, current, arg1, NULL);
+            } else if (count >= 2) {
                 delete_txt_file(current, arg1);
             } else {
                 printf("Uso: remover_arquivo <nome.txt>\n");
             }
+        } else if (strcmp(cmd, "buscar") == 0 || strcmp(cmd, "find") == 0) {
+            if (count >= 3) {
+                find_files(arg1, arg2);
+            } else {
+                printf("Uso: buscar tamanho <min> [max] | buscar modificado <duracao>\n");
+            }
         } else {
             printf("Comando não reconhecido: %s\n", cmd);
-            printf("Comandos disponíveis: criar_arquivo, criar_pasta, remover_arquivo, remover_pasta, cd, ls, sair\n");
+            printf("Comandos disponíveis: criar_arquivo, criar_pasta, remover_arquivo, remover_pasta, cd, ls, buscar, ");
+            printf("iniciar, confirmar, cancelar, sair\n");
         }
     }
+    if (batch.ativa) {
+        printf("Transação não confirmada: %zu operações descartadas.\n", batch.n);
+        batch_clear(&batch);
+    }
     
     save_filesystem_image(root, "fs.img");
     printf("Sistema de arquivos salvo em fs.img. Encerrando.\n");